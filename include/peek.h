@@ -13,13 +13,77 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <strings.h>
 #include <signal.h>
 #include <limits.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <regex.h>
+#include <time.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#define PEEK_WATCH_INOTIFY
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+#include <sys/event.h>
+#define PEEK_WATCH_KQUEUE
+#endif
+#ifdef PEEK_SQLITE
+#include <sqlite3.h>
+#endif
+#ifdef PEEK_LIBPQ
+#include <libpq-fe.h>
+#endif
+#if defined(PEEK_SQLITE) || defined(PEEK_LIBPQ)
+#define PEEK_NATIVE_SQL
+#endif
+#ifdef PEEK_DECOMPRESS
+#include <zlib.h>
+#include <bzlib.h>
+#include <lzma.h>
+#endif
 
-#define MAX_BUFFERS 50
-#define MAX_LINES 10000
-#define MAX_LINE_LEN 2048
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define LINE_CHUNK_SHIFT 12
+#define LINE_CHUNK_LINES (1 << LINE_CHUNK_SHIFT)
+#define ARENA_BLOCK_SIZE (256 * 1024)
+#define STREAM_READ_BUDGET (1024 * 1024)
+#define STREAM_STARTUP_MS 200
+#define INPUT_BATCH_KEYS 64
+#define HL_MAX_TOKENIZE (64 * 1024)
+#define INDEX_SLACK_LINES 256
+#define LEX_CHECKPOINT_LINES 256
+#define SEARCH_MAX_THREADS 16
+#define LOAD_MAX_THREADS 16
+#define GREP_BATCH_LINES (LINE_CHUNK_LINES * 16)
+#define SEARCH_SYNC_LINES (1 << 16)
+#define SEARCH_SYNC_BYTES (4 << 20)
+#define SEARCH_INDEX_STEP (1 << 18)
+#define SIDECAR_MIN_BYTES (16 << 20)
+#define WATCH_BATCH_MS 50
+#define TABLE_FETCH_ROWS 20000
+#define TABLE_MAX_CELL_WIDTH 120
+#define JSON_SCAN_LINES (1 << 16)
+#define JSON_INDEX_BUDGET (1 << 20)
+#define JSON_AUTO_FIELDS 8
+#define JSON_AUTO_SCAN_LINES 100
+#define FILTER_SCAN_LINES (1 << 18)
+#define FILTER_INDEX_BUDGET (1 << 22)
+#define MEM_CHECK_MS 500
+#define HTTP_CACHE_ENTRIES 64
+#define PRERENDER_SLICE_US 2000
+#define PRERENDER_CHECK_LINES 64
 
 typedef enum {
     LANG_NONE = 0,
@@ -44,8 +108,140 @@ typedef enum {
     LANG_YAML
 } Language;
 
+// A view onto one line of text; not NUL-terminated when it points into a mapping
+typedef struct {
+    const char *text;
+    int len;
+} LineRef;
+
+// Line text is appended into large blocks that never move once allocated
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t cap;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+    size_t bytes;
+} Arena;
+
+// A run of one highlight color inside a line
+typedef struct {
+    int start;
+    int len;
+    short pair;
+    short bold;
+} HlSpan;
+
+typedef struct {
+    HlSpan *spans;
+    int count;
+    int ready;
+    unsigned lex_out;   // lexer state at the end of the line, valid once ready
+} HlLine;
+
+// Colors picked up from SGR sequences while a line is sanitized (--ansi)
+typedef struct {
+    HlSpan *spans;
+    int count;          // -1 once an allocation failed
+    int cap;
+} SpanList;
+
+typedef enum {
+    SEARCH_LITERAL = 0,
+    SEARCH_REGEX
+} SearchMode;
+
+// A search compiled once per prompt and shared by n/N, the count and the workers
+typedef struct {
+    char term[256];
+    SearchMode mode;
+    int icase;
+    int compiled;        // `re` holds a compiled regex
+    regex_t re;
+    char needle[256];    // literal every matching line contains, lowercased when icase
+    int needle_len;      // 0: a regex with no literal to prefilter on
+} SearchPattern;
+
+// Sorted numbers of the lines matching a pattern; lines [0, scanned) are done
+typedef struct {
+    char term[256];
+    SearchMode mode;
+    int icase;
+    int *lines;
+    int count;
+    int cap;
+    int scanned;
+} MatchIndex;
+
+// In-process decompressor state for a compressed file stream
+typedef struct Decoder Decoder;
+
+// Columnar result of a native SQL query (see load_sql_native)
+typedef struct Table Table;
+
+// Fields of another tab's JSON-lines records laid out as a table (see prompt_json_view)
+typedef struct JsonView JsonView;
+
+// The lines of another tab that match a pattern, as line numbers into it (see prompt_filter_view)
+typedef struct FilterView FilterView;
+
+// Incremental input for stdin and command buffers, drained from the main loop
+typedef struct {
+    int active;
+    int fd;
+    pid_t pid;
+    char *partial;
+    size_t partial_len;
+    size_t partial_cap;
+    Decoder *dec;       // Set when the fd carries compressed bytes
+    int note_empty;     // Say "(no output)" if the producer exits silently
+} Stream;
+
+// A fetch for an HTTP/wget/w3m/RSS buffer that the response cache settles once it ends
+typedef struct {
+    int pending;            // Streaming; http_fetch_done runs when the stream closes
+    char kind;              // 'h' xh, 'g' wget, 'w' w3m, 'r' RSS
+    int conditional;        // Validators were sent, so a 304 can come back
+    char headers[64];       // Temp file curl dumps the response headers to; empty when they lead the output (xh)
+} HttpFetch;
+
+// What the response cache knows about one request; its lines are saved next to it on disk
 typedef struct {
-    char *lines[MAX_LINES];
+    uint64_t hash;
+    char *key;              // Kind letter, a space and the request
+    char etag[256];
+    char last_modified[64];
+    long max_age;           // Seconds the saved lines stay fresh without asking; 0: always revalidate
+    long long stored;       // time() of the last 200 or 304
+} HttpCacheEntry;
+
+// Screen rows of wrapped lines at one text width, counted lazily chunk by chunk
+typedef struct {
+    int width;              // Text width the rows are counted at; 0 while empty
+    int **rows;             // Per chunk: rows above each of its lines, LINE_CHUNK_LINES + 1 prefix sums
+    int *covered;           // Lines of each chunk counted so far
+    long long *starts;      // Rows above each chunk; known for chunks [0, starts_known)
+    int starts_known;
+    int chunk_cap;
+} WrapLayout;
+
+// Filesystem watch on a file buffer (--watch)
+typedef struct {
+    int active;
+    int wd;             // inotify watch descriptor, or the file's kqueue fd
+    int dir_fd;         // kqueue fd on the parent directory, for rotation
+    ino_t ino;          // Inode the watch was placed on
+    int pending;        // An event arrived; refresh at the end of the batch
+} FileWatch;
+
+typedef struct {
+    Arena text;
+    LineRef **line_chunks;
+    int chunk_count;
+    int chunk_cap;
     int line_count;
     char filepath[1024];
     char http_request[512];
@@ -53,13 +249,214 @@ typedef struct {
     int scroll_offset;
     int is_active;
     int is_http_buffer;
+    HttpFetch fetch;
+    // mmap backend: lines are indexed lazily out of the mapping
+    const char *map;
+    size_t map_size;
+    size_t map_scanned;
+    int index_complete;
+    struct stat map_st;
+    // Mapping offset of the first line of each chunk; chunks may be NULL until touched
+    size_t *chunk_offsets;
+    int chunk_offsets_cap;
+    size_t sidecar_bytes;   // index coverage already saved in the sidecar
+    Stream stream;
+    FileWatch watch;
+    Table *table;           // Rows of a native SQL result; lines are formatted from it on demand
+    JsonView *json;         // Set on a JSON-lines view tab; lines are formatted from its source
+    FilterView *filter;     // Set on a filtered tab; its lines are refs into the source's
+    unsigned generation;    // Bumped whenever the lines are thrown away, so views start over
+    unsigned ref_epoch;     // Bumped when line refs move but keep their lines, so views refill
+    WrapLayout wrap;
+    int follow;
+    int loading;            // Placeholder for a file still being loaded at startup
+    int resume_offset;      // Scroll position to restore once a reload streams back to it
+    // Highlight spans per line, filled in as lines are drawn
+    HlLine **hl_chunks;
+    int hl_chunk_count;
+    Arena hl_spans;
+    // Lexer state entering line k * LEX_CHECKPOINT_LINES, for multi-line constructs
+    unsigned *lex_checkpoints;
+    int lex_checkpoint_count;
+    int lex_checkpoint_cap;
+    MatchIndex matches;
+    // Load timings for the stats overlay and --stats=json, in microseconds
+    long long load_start_us;    // When the current contents started loading; 0 if not timed
+    long long ready_us;         // Until the first line was in
+    long long done_us;          // Until the input ended (a mapping: until it was mapped)
+    size_t bytes_in;            // Raw bytes read from a stream (mappings count map_scanned)
+    // Memory budget (--mem-budget): a background tab may give up its line data
+    int evicted;                // Lines are unmapped or spilled; buffer_rehydrate brings them back
+    char *spill_path;           // Temp file holding an evicted stream buffer's lines
+    uint64_t evict_hash;        // sidecar_hash of the mapping when it was dropped
+    unsigned long shown;        // When the tab was last current, in mem_touch ticks
 } Buffer;
 
+// One line chunk's worth of a background search
+typedef struct {
+    const LineRef *refs;
+    int first_line;
+    int count;
+    int *hits;
+    int hit_count;
+    int done;
+} SearchShard;
+
+// Background search of one buffer, shared with the worker threads under `lock`
+typedef struct {
+    int active;
+    Buffer *buf;
+    const SearchPattern *pat;
+    unsigned generation;  // bumped per search so workers recompile their regex copy
+    SearchShard *shards;
+    int shard_count;
+    int shard_cap;
+    int next_shard;     // next shard a worker will take
+    int merged;         // shards [0, merged) are already in buf->matches
+    int queued_to;      // lines [0, queued_to) are searched or queued
+    int pending_hits;   // hits in finished shards not merged yet
+    int jump_pending;
+    int cancel;
+    int busy;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t idle;
+    pthread_t threads[SEARCH_MAX_THREADS];
+    int thread_count;
+    int wake[2];        // workers write a byte here when a shard finishes
+} SearchJob;
+
+// One file argument being loaded off the main thread at startup
+typedef struct {
+    char path[1024];
+    Buffer *placeholder;    // The tab standing in for it; NULL once that tab is closed
+    Buffer *loaded;         // Filled by the worker
+    int rc;
+    int done;
+    int collected;
+} LoadJob;
+
+// Worker pool for startup loads; finished jobs are announced on the wake pipe
+typedef struct {
+    LoadJob *jobs;
+    int count;
+    int next;               // Next job a worker picks up
+    int finished;
+    int collected;
+    pthread_mutex_t lock;
+    int wake[2];
+} LoadPool;
+
+// What a --grep run looks for and how much context it prints around matches
+typedef struct {
+    const char *term;
+    SearchMode mode;
+    int smart_case;
+    int before;             // Context lines above each match (-B)
+    int after;              // Context lines below each match (-A)
+    int show_names;         // Prefix output lines with the file name
+} GrepOptions;
+
+// A copy of a line of before-context, kept past the batch that held it
+typedef struct {
+    char *text;
+    int len;
+    int cap;
+} GrepLine;
+
+// Output position of one --grep input
+typedef struct {
+    FILE *out;
+    const char *name;
+    const GrepOptions *opts;
+    GrepLine *ring;         // Line n of the last `before` lines sits at ring[n % before]
+    int printed_to;         // Line after the last one written
+    int after_left;         // After-context lines still owed to the last match
+    int any;                // Something was written, so a gap gets a "--" separator
+    long matches;
+} GrepState;
+
+// One --grep input; a worker fills `out` and the main thread copies it out in order
+typedef struct {
+    const char *path;
+    int is_command;         // `path` is a -m command string
+    FILE *out;
+    int rc;                 // 0 matched, 1 no match, 2 error
+    int done;
+} GrepJob;
+
+typedef struct {
+    GrepJob *jobs;
+    int count;
+    int next;
+    const GrepOptions *opts;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} GrepPool;
+
+// Frame and search timings for the stats overlay and --stats=json, in microseconds
+typedef struct {
+    long long frames;
+    long long frame_us_total;
+    long long frame_us_max;
+    long long frame_us_last;
+    long long searches;
+    long long search_us_total;
+    long long search_us_max;
+    long long search_us_last;
+    long long search_started;   // Start of the background search in flight, 0 if none
+} Stats;
+
+// Idle-time warming of the screens around the view; restarts whenever the view moves
+typedef struct {
+    // The view the plan was made for
+    const Buffer *buf;
+    int scroll_offset;
+    int line_count;
+    int width;
+    int height;
+    int buffer_count;
+    unsigned generation;
+    int started;
+    int stage;              // Next PRERENDER_* target
+    int line;               // Next line of that target; -1 until it is laid out
+} Prerender;
+
+// What the last frame put on screen, so draw_ui only repaints what changed
+typedef struct {
+    int valid;
+    int rows;
+    int cols;
+    const Buffer *buf;
+    int scroll_offset;
+    int line_count;
+    int horiz_scroll_offset;
+    int wrap_enabled;
+    int show_line_numbers;
+    int copy_mode;
+    int copy_start_line;
+    int copy_end_line;
+    // Longest line on the screen, remembered while the same lines are shown
+    const Buffer *widest_buf;
+    int widest_top;
+    int widest_rows;
+    int widest_lines;
+    int widest_len;
+    unsigned long tab_sig;
+    int tab_current;
+    int tab_count;
+    char status_left[512];
+    char status_right[256];
+} ScreenCache;
+
 typedef struct {
-    Buffer buffers[MAX_BUFFERS];
+    Buffer **buffers;
+    int buffer_cap;
     int buffer_count;
     int current_buffer;
     char search_term[256];
+    SearchPattern search_pattern;
+    int smart_case;
     int search_line;
     int search_match_count;
     int current_match;
@@ -70,6 +467,8 @@ typedef struct {
     int copy_end_line;
     int horiz_scroll_offset;
     int horiz_scroll_step;
+    int show_stats;
+    ScreenCache screen;
 } ViewerState;
 
 // Color pairs
@@ -84,9 +483,34 @@ typedef struct {
 #define COLOR_STATUS 9
 #define COLOR_LINENR 10
 #define COLOR_COPY_SELECT 11
+#define COLOR_ANSI 12            // 12..19: the 8 ANSI foreground colors (--ansi)
 
 // Function declarations
 static int is_pdf_file(const char *filepath);
 void free_buffer(Buffer *buf);
+static LineRef *buffer_fill_chunk(Buffer *buf, int chunk);
+static void sidecar_save(Buffer *buf);
+static void decoder_close(Decoder *d);
+static void watch_remove(Buffer *buf);
+static void table_free(Buffer *buf);
+static int load_file_into(Buffer *buf, const char *filepath);
+static int table_fetching(const Buffer *buf);
+static LineRef *table_fill_chunk(Buffer *buf, int chunk);
+static void search_job_cancel(const Buffer *buf);
+static void json_view_free(Buffer *buf);
+static LineRef *json_fill_chunk(Buffer *buf, int chunk);
+static int json_index_to(Buffer *buf, int want);
+static void json_reset(Buffer *buf);
+static const Buffer *view_source(const Buffer *buf);
+static int view_depends_on(const Buffer *buf, const Buffer *on);
+static void filter_view_free(Buffer *buf);
+static LineRef *filter_fill_chunk(Buffer *buf, int chunk);
+static int filter_index_to(Buffer *buf, int want);
+static void filter_reset(Buffer *buf);
+static int buffer_loading(const Buffer *buf);
+static void mem_touch(ViewerState *state);
+static size_t buffer_resident_bytes(const Buffer *buf);
+static void wrap_reset(WrapLayout *w);
+static void wrap_invalidate(Buffer *buf, int line);
 
 #endif
\ No newline at end of file
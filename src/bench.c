@@ -0,0 +1,314 @@
+/*
+ * Headless benchmarks (make bench). main.c is compiled in whole, so the
+ * harness drives the same static loaders, search and drawing code the
+ * viewer runs. It writes synthetic corpora to a temporary directory, then
+ * reports load and search throughput and the time per frame drawn to a
+ * virtual ncurses screen whose output goes to /dev/null.
+ *
+ *   bin/peek-bench [MB]     size of the largest corpus, 64 by default
+ */
+#define main peek_main
+#include "main.c"
+#undef main
+
+#define BENCH_ROWS 50
+#define BENCH_COLS 200
+
+static char g_bench_dir[] = "/tmp/peek-bench.XXXXXX";
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, double secs, double bytes, double lines) {
+    printf("%-42s %9.1f ms", name, secs * 1000.0);
+    if (bytes > 0) printf("  %9.1f MB/s", bytes / (1 << 20) / secs);
+    // A handful of huge lines makes lines/s meaningless
+    if (lines >= 1000) printf("  %7.2f M lines/s", lines / 1e6 / secs);
+    printf("\n");
+}
+
+static void report_frames(const char *name, double secs, int frames) {
+    printf("%-42s %9.3f ms/frame  %7.0f frames/s\n", name, secs * 1000.0 / frames, frames / secs);
+}
+
+/*
+ * Corpora. Each generator writes about `bytes` bytes of one kind of input:
+ * many short log lines, a few huge minified lines, colored log output and
+ * C source.
+ */
+static void gen_short(FILE *f, size_t bytes) {
+    size_t n = 0;
+    for (unsigned i = 0; n < bytes; i++) {
+        int w = fprintf(f, "2026-10-14 12:%02u:%02u INFO worker-%02u request id=%08x took %u ms path=/api/v1/items/%u\n",
+                        (i / 60) % 60, i % 60, i % 16, i * 2654435761u, i % 997, i % 100000);
+        n += (size_t)w;
+    }
+}
+
+static void gen_huge(FILE *f, size_t bytes) {
+    size_t per_line = bytes / 4;
+    for (int l = 0; l < 4; l++) {
+        size_t n = 1;
+        fputc('{', f);
+        for (unsigned i = 0; n < per_line; i++) {
+            n += (size_t)fprintf(f, "\"key%06u\":[%u,%u,\"value-%x\"],", i, i % 7, i % 1000, i * 40503u);
+        }
+        fputs("\"end\":true}\n", f);
+    }
+}
+
+static void gen_ansi(FILE *f, size_t bytes) {
+    size_t n = 0;
+    static const char *levels[] = { "\033[32mINFO\033[0m", "\033[33mWARN\033[0m", "\033[1;31mERROR\033[0m" };
+    for (unsigned i = 0; n < bytes; i++) {
+        n += (size_t)fprintf(f, "\033[2m2026-10-14T12:%02u:%02u\033[0m %s \033[1mworker-%02u\033[22m request "
+                             "\033[36mid=%08x\033[39m took \033[38;5;208m%u\033[0m ms\n",
+                             (i / 60) % 60, i % 60, levels[i % 7 == 0 ? 2 : i % 3 == 0], i % 16,
+                             i * 2654435761u, i % 997);
+    }
+}
+
+static void gen_code(FILE *f, size_t bytes) {
+    size_t n = 0;
+    for (unsigned i = 0; n < bytes; i++) {
+        n += (size_t)fprintf(f,
+            "/*\n * Process batch %u of the request queue.\n */\n"
+            "static int process_batch_%u(struct queue *q, const char *name, size_t limit) {\n"
+            "    int count = 0;  // items handled\n"
+            "    for (size_t i = 0; i < limit && i < q->len; i++) {\n"
+            "        if (strcmp(q->items[i].name, \"batch-%u\") == 0) count += 0x%x;\n"
+            "        else if (q->items[i].weight > %u.5) return -1;\n"
+            "    }\n"
+            "    printf(\"%%s: %%d\\n\", name, count);\n"
+            "    return count;\n"
+            "}\n\n", i, i, i, i & 0xFFF, i % 100);
+    }
+}
+
+static void write_corpus(const char *path, void (*gen)(FILE *, size_t), size_t bytes) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    gen(f, bytes);
+    fclose(f);
+}
+
+static double file_bytes(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (double)st.st_size : 0;
+}
+
+// load_file plus a full line index, the path a file argument takes
+static Buffer *bench_load(const char *label, const char *path) {
+    Buffer *buf = calloc(1, sizeof(Buffer));
+    if (!buf) exit(1);
+    double t = now_sec();
+    if (load_file(buf, path) != 0) {
+        fprintf(stderr, "peek-bench: cannot load %s\n", path);
+        exit(1);
+    }
+    buffer_index_all(buf);
+    t = now_sec() - t;
+    char name[64];
+    snprintf(name, sizeof(name), "load %s", label);
+    report(name, t, file_bytes(path), buf->line_count);
+    return buf;
+}
+
+// The same file read through the stream path stdin and commands use
+static void bench_stream(const char *label, const char *path) {
+    Buffer *buf = calloc(1, sizeof(Buffer));
+    int fd = open(path, O_RDONLY);
+    if (!buf || fd < 0) exit(1);
+    double t = now_sec();
+    stream_open(buf, fd, 0);
+    while (buf->stream.active) stream_pump(buf);
+    t = now_sec() - t;
+    char name[64];
+    snprintf(name, sizeof(name), "stream %s", label);
+    report(name, t, file_bytes(path), buf->line_count);
+    free_buffer(buf);
+    free(buf);
+}
+
+static void bench_search(ViewerState *state, const char *label, const char *term, SearchMode mode, double bytes) {
+    Buffer *buf = state->buffers[state->current_buffer];
+    char err[128];
+    search_job_cancel(NULL);
+    if (search_pattern_compile(&state->search_pattern, term, mode, 1, err, sizeof(err)) != 0) {
+        fprintf(stderr, "peek-bench: %s: %s\n", term, err);
+        return;
+    }
+    strncpy(state->search_term, term, sizeof(state->search_term) - 1);
+    char name[96];
+
+    // One thread, as a search small enough to run between keystrokes does
+    buf->matches.term[0] = '\0';
+    double t = now_sec();
+    int hits = buffer_matches(buf, &state->search_pattern)->count;
+    t = now_sec() - t;
+    snprintf(name, sizeof(name), "search %s (%d hits)", label, hits);
+    report(name, t, bytes, buf->line_count);
+
+    // The background pool, driven the way the main loop drives it
+    buf->matches.term[0] = '\0';
+    t = now_sec();
+    if (!search_start(state)) return;
+    while (g_search.active) {
+        struct pollfd pfd = { .fd = g_search.wake[0], .events = POLLIN };
+        if (!search_needs_main()) poll(&pfd, 1, 10);
+        search_step(state);
+    }
+    t = now_sec() - t;
+    snprintf(name, sizeof(name), "search %s, pool", label);
+    report(name, t, bytes, buf->line_count);
+}
+
+enum { FRAMES_PAGE, FRAMES_SCROLL, FRAMES_REDRAW, FRAMES_HSCROLL };
+
+// Draw `frames` frames, moving the view between them as `how` says
+static void bench_frames(ViewerState *state, const char *label, int how, int wrap, int frames) {
+    Buffer *buf = state->buffers[state->current_buffer];
+    int height = BENCH_ROWS - 4;
+    state->wrap_enabled = wrap;
+    state->horiz_scroll_offset = 0;
+    buf->scroll_offset = 0;
+    state->screen.valid = 0;
+    draw_ui(state);
+    double t = now_sec();
+    for (int i = 0; i < frames; i++) {
+        switch (how) {
+            case FRAMES_PAGE:
+                buf->scroll_offset += height;
+                if (buf->scroll_offset >= buf->line_count) buf->scroll_offset = 0;
+                break;
+            case FRAMES_SCROLL:
+                if (++buf->scroll_offset >= buf->line_count) buf->scroll_offset = 0;
+                break;
+            case FRAMES_REDRAW:
+                state->screen.valid = 0;
+                break;
+            case FRAMES_HSCROLL:
+                state->horiz_scroll_offset += BENCH_COLS / 2;
+                break;
+        }
+        draw_ui(state);
+    }
+    t = now_sec() - t;
+    char name[96];
+    snprintf(name, sizeof(name), "render %s%s", label, wrap ? "" : ", no wrap");
+    report_frames(name, t, frames);
+}
+
+// A screen that renders into /dev/null, sized like a large terminal window
+static int open_virtual_screen(void) {
+    static const char *terms[] = { "xterm-256color", "xterm", "vt100" };
+    FILE *out = fopen("/dev/null", "w");
+    FILE *in = fopen("/dev/null", "r");
+    if (!out || !in) return 0;
+    for (size_t i = 0; i < sizeof(terms) / sizeof(terms[0]); i++) {
+        g_screen = newterm(terms[i], out, in);
+        if (g_screen) break;
+    }
+    if (!g_screen) return 0;
+    set_term(g_screen);
+    resize_term(BENCH_ROWS, BENCH_COLS);
+    init_colors();
+    idlok(stdscr, TRUE);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    setlocale(LC_ALL, "");
+    double mb = argc > 1 ? atof(argv[1]) : 64;
+    if (mb <= 0) mb = 64;
+    size_t bytes = (size_t)(mb * (1 << 20));
+    if (!mkdtemp(g_bench_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char p_short[64], p_huge[64], p_ansi[64], p_code[64];
+    snprintf(p_short, sizeof(p_short), "%s/short.log", g_bench_dir);
+    snprintf(p_huge, sizeof(p_huge), "%s/huge.json", g_bench_dir);
+    snprintf(p_ansi, sizeof(p_ansi), "%s/ansi.log", g_bench_dir);
+    snprintf(p_code, sizeof(p_code), "%s/code.c", g_bench_dir);
+    printf("peek-bench: writing corpora (%.0f MB short lines, %.0f MB each huge lines / ANSI, %.0f MB C) to %s\n",
+           mb, mb / 2, mb / 4, g_bench_dir);
+    write_corpus(p_short, gen_short, bytes);
+    write_corpus(p_huge, gen_huge, bytes / 2);
+    write_corpus(p_ansi, gen_ansi, bytes / 2);
+    write_corpus(p_code, gen_code, bytes / 4);
+
+    ViewerState *state = calloc(1, sizeof(ViewerState));
+    if (!state) return 1;
+    state->show_line_numbers = 1;
+    state->horiz_scroll_step = 8;
+    state->smart_case = 1;
+    Buffer *slot = NULL;
+    state->buffers = &slot;
+    state->buffer_count = 1;
+
+    printf("\n");
+    Buffer *b_short = bench_load("short lines", p_short);
+    Buffer *b_huge = bench_load("huge lines", p_huge);
+    Buffer *b_ansi = bench_load("ANSI", p_ansi);
+    g_keep_ansi = 1;
+    Buffer *b_ansi_kept = bench_load("ANSI --ansi", p_ansi);
+    g_keep_ansi = 0;
+    Buffer *b_code = bench_load("C source", p_code);
+    bench_stream("short lines", p_short);
+    bench_stream("ANSI", p_ansi);
+
+    printf("\n");
+    slot = b_short;
+    bench_search(state, "literal", "took 42 ms", SEARCH_LITERAL, file_bytes(p_short));
+    bench_search(state, "icase", "info worker-07", SEARCH_LITERAL, file_bytes(p_short));
+    bench_search(state, "regex", "id=[0-9a-f]+7 took", SEARCH_REGEX, file_bytes(p_short));
+    slot = b_huge;
+    bench_search(state, "huge lines", "\"end\":true", SEARCH_LITERAL, file_bytes(p_huge));
+    search_job_cancel(NULL);
+    search_pattern_free(&state->search_pattern);
+    state->search_term[0] = '\0';
+
+    printf("\n");
+    if (open_virtual_screen()) {
+        g_state = state;
+        slot = b_code;
+        bench_frames(state, "C, page down (cold)", FRAMES_PAGE, 1, 2000);
+        bench_frames(state, "C, page down (warm)", FRAMES_PAGE, 1, 2000);
+        bench_frames(state, "C, page down (warm)", FRAMES_PAGE, 0, 2000);
+        bench_frames(state, "C, line down", FRAMES_SCROLL, 1, 2000);
+        bench_frames(state, "C, full repaint", FRAMES_REDRAW, 1, 2000);
+        slot = b_short;
+        bench_frames(state, "short lines, page down", FRAMES_PAGE, 1, 2000);
+        slot = b_ansi_kept;
+        bench_frames(state, "ANSI --ansi, page down", FRAMES_PAGE, 1, 2000);
+        slot = b_huge;
+        bench_frames(state, "huge lines, full repaint", FRAMES_REDRAW, 1, 2000);
+        bench_frames(state, "huge lines, scroll right", FRAMES_HSCROLL, 0, 2000);
+        g_state = NULL;
+        endwin();
+        delscreen(g_screen);
+        g_screen = NULL;
+    } else {
+        printf("render: no usable terminfo entry, skipped\n");
+    }
+
+    Buffer *all[] = { b_short, b_huge, b_ansi, b_ansi_kept, b_code };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        free_buffer(all[i]);
+        free(all[i]);
+    }
+    free(state);
+    unlink(p_short);
+    unlink(p_huge);
+    unlink(p_ansi);
+    unlink(p_code);
+    rmdir(g_bench_dir);
+    return 0;
+}